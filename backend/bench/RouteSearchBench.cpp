@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include <random>
+#include <vector>
+
+#include "routing/RouteSearch.hpp"
+
+// Compares the fixed-size tour kernels against the generic fallback on the same
+// synthetic problems. Travel times come from a precomputed matrix so the numbers
+// measure the search itself, not the Distance Matrix API.
+//
+// The search is exhaustive over visited sets, so tours stop at kMaxPairs pairs. That
+// keeps fixed16 and fixed32 on the sizes findTour() gives them, but fixed64 (used from
+// 33 stops) and generic (used past 64 stops) are only timed on small tours here.
+
+namespace
+{
+    // 22 stops; the generic path already takes about ten seconds per run at capacity 4
+    constexpr int kMaxPairs = 11;
+
+    struct BenchProblem
+    {
+        RouteSearch::TourProblem problem;
+        std::vector<std::vector<int>> times; // global node -> global node, minutes
+    };
+
+    // Node 0 is the driver, then `pairs` pickups, then their drop-offs, wired the same
+    // way main.cpp wires a driver's subgraph.
+    BenchProblem makeProblem(int pairs, int capacity, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> coord(0, 60);
+
+        const int n = 1 + 2 * pairs;
+        std::vector<std::pair<int, int>> points(n);
+        for (auto& p : points) p = {coord(rng), coord(rng)};
+
+        BenchProblem bench;
+        bench.times.assign(n, std::vector<int>(n, 0));
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                bench.times[i][j] = 1 + std::abs(points[i].first - points[j].first) +
+                                    std::abs(points[i].second - points[j].second);
+            }
+        }
+
+        auto& problem = bench.problem;
+        problem.driver = 0;
+        problem.capacity = capacity;
+        problem.neighbors.resize(2 * pairs + 1);
+        for (int i = 0; i < 2 * pairs; ++i) {
+            problem.stops.push_back(i + 1);
+            problem.riders.push_back(i < pairs ? 1 : -1);
+            problem.pickupsOf.push_back(i < pairs ? std::vector<int>{} : std::vector<int>{i - pairs});
+            for (int j = 0; j < 2 * pairs; ++j) {
+                if (i != j) problem.neighbors[i].push_back(j);
+            }
+        }
+        for (int i = 0; i < pairs; ++i) problem.neighbors[2 * pairs].push_back(i);
+        return bench;
+    }
+
+    template <typename Search>
+    double medianMicros(const BenchProblem& bench, int reps, int& tourTime, Search search)
+    {
+        auto travelTime = [&](int from, int to) { return bench.times[from][to]; };
+        std::vector<double> samples;
+        for (int r = 0; r < reps; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            tourTime = search(bench.problem, travelTime).first;
+            auto end = std::chrono::steady_clock::now();
+            samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        }
+        std::nth_element(samples.begin(), samples.begin() + reps / 2, samples.end());
+        return samples[reps / 2];
+    }
+
+    // Timing of one search, or nothing if the kernel cannot hold the tour.
+    struct Cell
+    {
+        bool ran = false;
+        double micros = 0;
+        int tourTime = 0;
+    };
+
+    template <int MaxStops>
+    Cell runFixed(const BenchProblem& bench, int reps)
+    {
+        Cell cell;
+        if (static_cast<int>(bench.problem.stops.size()) > MaxStops) return cell;
+        cell.ran = true;
+        cell.micros = medianMicros(bench, reps, cell.tourTime, [](const RouteSearch::TourProblem& p, auto& t) {
+            return RouteSearch::searchFixed<MaxStops>(p, t);
+        });
+        return cell;
+    }
+
+    void printCell(const Cell& cell)
+    {
+        if (cell.ran) std::printf(" %12.1f", cell.micros);
+        else std::printf(" %12s", "-");
+    }
+
+    // Every kernel that can hold the tour against the generic path, by tour size.
+    bool benchSizes(int maxPairs, int reps)
+    {
+        std::printf("%6s %4s %12s %12s %12s %12s %12s\n",
+                    "stops", "cap", "generic(us)", "fixed16(us)", "fixed32(us)", "fixed64(us)", "dispatch(us)");
+
+        for (int capacity : {2, 4}) {
+            for (int pairs = 2; pairs <= maxPairs; ++pairs) {
+                const auto bench = makeProblem(pairs, capacity, 1234u + pairs);
+                Cell generic, dispatched;
+                generic.ran = dispatched.ran = true;
+                generic.micros = medianMicros(bench, reps, generic.tourTime, [](const RouteSearch::TourProblem& p, auto& t) {
+                    return RouteSearch::searchGeneric(p, t);
+                });
+                const Cell fixed16 = runFixed<16>(bench, reps);
+                const Cell fixed32 = runFixed<32>(bench, reps);
+                const Cell fixed64 = runFixed<64>(bench, reps);
+                dispatched.micros = medianMicros(bench, reps, dispatched.tourTime, [](const RouteSearch::TourProblem& p, auto& t) {
+                    return RouteSearch::findTour(p, t);
+                });
+
+                for (const Cell* cell : std::initializer_list<const Cell*>{&fixed16, &fixed32, &fixed64, &dispatched}) {
+                    if (cell->ran && cell->tourTime != generic.tourTime) {
+                        std::fprintf(stderr, "tour time mismatch at %d stops, capacity %d: generic %d, kernel %d\n",
+                                     2 * pairs, capacity, generic.tourTime, cell->tourTime);
+                        return false;
+                    }
+                }
+                std::printf("%6d %4d", 2 * pairs, capacity);
+                for (const Cell* cell : std::initializer_list<const Cell*>{&generic, &fixed16, &fixed32, &fixed64, &dispatched}) printCell(*cell);
+                std::printf("\n");
+            }
+        }
+        return true;
+    }
+
+    // Parses a whole decimal argument, or returns -1 if it is not one in [0, max].
+    int parseCount(const char* arg, int max)
+    {
+        char* end = nullptr;
+        const long value = std::strtol(arg, &end, 10);
+        if (end == arg || *end != '\0' || value < 0 || value > max) return -1;
+        return static_cast<int>(value);
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int maxPairs = argc > 1 ? parseCount(argv[1], kMaxPairs) : 10;
+    const int reps = argc > 2 ? parseCount(argv[2], 64) : 3;
+    if (maxPairs < 2 || reps < 1) {
+        std::fprintf(stderr, "usage: %s [max passenger pairs, 2-%d] [repetitions, 1-64]\n", argv[0], kMaxPairs);
+        return 2;
+    }
+
+    return benchSizes(maxPairs, reps) ? 0 : 1;
+}
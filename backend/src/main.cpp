@@ -1,15 +1,18 @@
 #include "crow.h"
 #include "crow/middlewares/cors.h"
+#include <climits>
 #include <cstdio>
 #include <stdio.h>
 #include <unordered_map>
 #include <iostream>
 #include <tuple>
 #include <unordered_set>
+#include <set>
 #include <queue>
 #include <curl/curl.h>
 #include <future>
 #include "utils/Utils.hpp"
+#include "routing/RouteSearch.hpp"
 #include "env.h"
 
 const std::string token = GOOGLE_API_KEY;
@@ -74,6 +77,8 @@ struct RoutingContext{
     std::unordered_set<int> sourceSet;
     std::unordered_set<int> destSet;
     std::vector<Coord> nodes;
+    std::vector<int> driverCapacity; // seats per driver, indexed by driver node
+    std::vector<std::pair<int, int>> passengers; // (source, dest) node of every distinct passenger
 
 };
 //helper to print roles
@@ -85,6 +90,15 @@ std::string roleToString(Coord::Role role) {
         default: return "Unknown";
     }
 }
+// Reads a seat count, false unless it is a whole JSON number in [1, INT_MAX]
+bool readCapacity(const crow::json::rvalue& v, int& capacity) {
+    if (v.t() != crow::json::type::Number) return false;
+    if (v.nt() != crow::json::num_type::Signed_integer && v.nt() != crow::json::num_type::Unsigned_integer) return false;
+    double value = v.d();
+    if (value < 1 || value > INT_MAX) return false;
+    capacity = static_cast<int>(value);
+    return true;
+}
 // A small helper to capture libcurl’s response into a std::string
 static size_t _curlWrite(void* buf, size_t size, size_t nmemb, void* up) {
     std::string* resp = static_cast<std::string*>(up);
@@ -186,51 +200,59 @@ int getTime(const Coord& start, const Coord& end) {
 }
 
 
-std::pair<int, std::vector<int>> findRoute(std::vector<std::vector<int>>& adj, int maxNodes, int driverIdx, RoutingContext& ctx) {
-    using namespace std;
-    // time, node, visited set, and path 
-    using nodeType = tuple<int, int, unordered_set<int>, vector<int>, int>;
-    
-    auto cmp = [] (nodeType& a, nodeType& b) -> bool {
-        return get<0>(a) > get<0>(b); 
+// Shortest tour from driverIdx that carries every passenger picked up at one of
+// sources, following adj and the driver's seat limit. Dispatches to a kernel sized
+// for the tour in RouteSearch.
+std::pair<int, std::vector<int>> findRoute(std::vector<std::vector<int>>& adj, const std::vector<int>& sources, int driverIdx, RoutingContext& ctx) {
+    RouteSearch::TourProblem problem;
+    problem.driver = driverIdx;
+    problem.capacity = ctx.driverCapacity[driverIdx];
+
+    // global node -> index within this tour, the driver goes last. Passengers sharing
+    // a pickup or drop-off coordinate share one stop.
+    std::unordered_map<int, int> localOf;
+    auto addStop = [&](int node) {
+        auto [it, inserted] = localOf.emplace(node, static_cast<int>(problem.stops.size()));
+        if (inserted) {
+            problem.stops.push_back(node);
+            problem.riders.push_back(0);
+            problem.pickupsOf.emplace_back();
+        }
+        return it->second;
     };
-
-    priority_queue<nodeType, vector<nodeType>, decltype(cmp)> q(cmp);
-  //  unordered_map<pair<int, int>, int, nodeHash> storedTimes; 
-
-    q.push({0, driverIdx, unordered_set<int>(), vector<int>(1, driverIdx), 0}); 
-    while (!q.empty()) {
-        auto [cTime, cNode, cSet, cPath, cInCar] = q.top();
-        q.pop();
-
-        for (auto neighbor : adj[cNode]) {
-            if (ctx.sourceSet.count(neighbor) && cInCar == 4) continue;
-            if (cSet.count(neighbor)) continue; 
-            if (ctx.destSet.count(neighbor) && !cSet.count(ctx.destToSource[neighbor])) continue; 
-            if (!ctx.storedTimes.count({cNode, neighbor})) {
-                ctx.storedTimes[{cNode, neighbor}] = getTime(ctx.nodes[cNode], ctx.nodes[neighbor]);
-            }
-
-            if (ctx.destSet.count(neighbor)){
-                cInCar -= 1;
-            } else{
-                cInCar += 1;
+    std::unordered_set<int> served(sources.begin(), sources.end());
+    for (auto const& [source, dest] : ctx.passengers) {
+        if (!served.count(source)) continue;
+        int pickup = addStop(source);
+        int dropoff = addStop(dest);
+        problem.riders[pickup] += 1;
+        problem.riders[dropoff] -= 1;
+        problem.pickupsOf[dropoff].push_back(pickup);
+    }
+    localOf[driverIdx] = static_cast<int>(problem.stops.size());
+
+    problem.neighbors.resize(problem.stops.size() + 1);
+    for (auto const& [node, local] : localOf) {
+        for (int neighbor : adj[node]) {
+            auto it = localOf.find(neighbor);
+            if (it != localOf.end() && neighbor != driverIdx) {
+                problem.neighbors[local].push_back(it->second);
             }
-            int newTime = cTime; auto newSet = cSet; auto newPath = cPath; 
-            // Add time to neighbor onto current time
-            newTime += ctx.storedTimes[{cNode, neighbor}];
-            // Add neighbor to visited nodes + onto path 
-            newSet.insert(neighbor); newPath.push_back(neighbor);
-            // End BFS if all passengers have been dropped
-            if (newSet.size() >= maxNodes) return {newTime, newPath}; 
-
-            q.push({newTime, neighbor, newSet, newPath, cInCar});
         }
     }
-    for (const auto& pair: ctx.storedTimes){
-        std::cout << "(" << pair.first.first << ", " << pair.first.second << ") => " << pair.second << "\n";
+
+    auto result = RouteSearch::findTour(problem, [&ctx](int from, int to) {
+        if (!ctx.storedTimes.count({from, to})) {
+            ctx.storedTimes[{from, to}] = getTime(ctx.nodes[from], ctx.nodes[to]);
+        }
+        return ctx.storedTimes[{from, to}];
+    });
+    if (result.first < 0) {
+        for (const auto& pair: ctx.storedTimes){
+            std::cout << "(" << pair.first.first << ", " << pair.first.second << ") => " << pair.second << "\n";
+        }
     }
-    return {-1, {}};
+    return result;
 }
 
 std::unordered_map<int, std::vector<int>> decipherRoutes(RoutingContext& ctx ){
@@ -355,6 +377,13 @@ int main()
     std::unordered_map<Coord,int,CoordHash> indexOf;
     std::vector<std::pair<std::pair<double,double>,std::pair<double,double>>> orderedPaxList;
     std::vector<std::pair<double,double>> orderedDriList;
+    std::vector<int> orderedDriCapacity;
+
+    // seats per car, a driver entry may override it with a third element
+    int defaultCapacity = RouteSearch::kDefaultCapacity;
+    if (j.has("capacity") && !readCapacity(j["capacity"], defaultCapacity)) {
+        return crow::response(400, "Capacity must be a whole number of at least 1");
+    }
     // extract passengers 
     if (j.has("passengers") && j["passengers"].t() == crow::json::type::List) {
         auto& paxList = j["passengers"];
@@ -380,12 +409,17 @@ int main()
         auto& driList = j["drivers"];
         std::cout << "Got " << driList.size() << " driver entries\n";
 
-        // each entry is itself a one element list of [lat,lng] pairs
+        // each entry is a [lat,lng] pair, optionally followed by the car's capacity
         for (size_t i = 0; i < driList.size(); ++i) {
             auto& pairArr = driList[i];  // this is also an rvalue[List]
                 // pull out just one coord
                 std::pair<double,double> srcCoords = {pairArr[0].d(), pairArr[1].d()};
                 orderedDriList.push_back(srcCoords);
+                int capacity = defaultCapacity;
+                if (pairArr.size() > 2 && !readCapacity(pairArr[2], capacity)) {
+                    return crow::response(400, "Capacity must be a whole number of at least 1");
+                }
+                orderedDriCapacity.push_back(capacity);
         }
     }
     else {
@@ -407,15 +441,17 @@ int main()
     
     //consructing of adjacencylist 
     //1) insert drivers 
-    for (auto const &drv : orderedDriList) {
+    RoutingContext ctx;
+    for (size_t i = 0; i < orderedDriList.size(); ++i) {
+        auto const &drv = orderedDriList[i];
         Coord c{ drv.first, drv.second, Coord::Role::Driver };
         if (indexOf.find(c) == indexOf.end()) {
             int idx = static_cast<int>(nodes.size());
             nodes.push_back(c);
             indexOf[c] = idx;
+            ctx.driverCapacity.push_back(orderedDriCapacity[i]);
         }
     }
-    RoutingContext ctx;
     int D = static_cast<int>(nodes.size()); 
     ctx.numOfDrivers = D;
 
@@ -452,6 +488,7 @@ int main()
     std::unordered_set<int> destSet;
 
     //constructing 2 maps between source and dest and dest and source 
+    std::set<std::pair<int, int>> seenPassengers;
     for (auto const &pr : orderedPaxList){
         auto const &srcPair = pr.first;
         auto const &dstPair = pr.second;
@@ -463,6 +500,9 @@ int main()
         destSet.insert(dstIndex);
         sourceToDest[srcIndex] = dstIndex;
         destToSource[dstIndex] = srcIndex;
+        if (seenPassengers.insert({srcIndex, dstIndex}).second) {
+            ctx.passengers.emplace_back(srcIndex, dstIndex);
+        }
     }
     
     ctx.destSet = destSet;
@@ -535,7 +575,8 @@ int main()
         for (const auto& [dst, src] : destToSource) {
             std::cout << "  Destination " << dst << " -> Source " << src << "\n";
         }
-    auto [shortestTime, path] = findRoute(adj, adj.size(), 0, ctx);
+    std::vector<int> sources(sourceSet.begin(), sourceSet.end());
+    auto [shortestTime, path] = findRoute(adj, sources, 0, ctx);
     setOfPaths.insert({shortestTime, path});
     } else {
         for (const auto& [driverIdx, assignedSources] : assignmentRes) {
@@ -546,29 +587,20 @@ int main()
                     //driver i -> all passengers source
                     currentSubAdj[driverIdx].push_back(source);
                 }
-                int assignedSourcesSize = assignedSources.size();
-                //passenger source -> every other source / dest besides itself
-                for (int i = 0; i < assignedSourcesSize; i++){
-                    int src = assignedSources[i];
-                    for (int j = 0; j < assignedSourcesSize; j++){
-                        auto otherSrc = assignedSources[j];
-                        int otherDest = sourceToDest[otherSrc];
-                        if (i != j){
-                            currentSubAdj[src].push_back(otherSrc);
-                        }
-                        currentSubAdj[src].push_back(otherDest);
+                //sources plus the dest of every passenger picked up at them, each node once
+                std::vector<int> tourNodes(assignedSources.begin(), assignedSources.end());
+                for (auto const& [source, dest] : ctx.passengers) {
+                    bool served = std::find(assignedSources.begin(), assignedSources.end(), source) != assignedSources.end();
+                    if (served && std::find(tourNodes.begin(), tourNodes.end(), dest) == tourNodes.end()) {
+                        tourNodes.push_back(dest);
                     }
                 }
-                //dest -> every source/dest besides itself 
-                for (int i = 0; i < assignedSourcesSize; i++){
-                    int dest = sourceToDest[assignedSources[i]];
-                    for (int j = 0; j < assignedSourcesSize; j++){
-                        int otherSrc = assignedSources[j];
-                        int otherDest = sourceToDest[otherSrc];
-                        if (i != j){
-                            currentSubAdj[dest].push_back(otherDest);
+                //passenger source / dest -> every other source / dest besides itself
+                for (int node : tourNodes){
+                    for (int other : tourNodes){
+                        if (node != other){
+                            currentSubAdj[node].push_back(other);
                         }
-                        currentSubAdj[dest].push_back(otherSrc);
                     }
                 }
                 
@@ -596,7 +628,7 @@ int main()
                     std::cout << "\n";
                 }
                 
-                auto [shortestTime, path] = findRoute(currentSubAdj, assignedSourcesSize * 2, driverIdx, ctx);
+                auto [shortestTime, path] = findRoute(currentSubAdj, assignedSources, driverIdx, ctx);
 
                 std::cout << "Shortest time: " << shortestTime << "\n";   
                     std::cout << path.size() << "\n";   
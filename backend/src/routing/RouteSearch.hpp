@@ -0,0 +1,236 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <tuple>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Pickup/drop-off tour search for a single driver.
+//
+// findTour() picks a kernel from the size of the tour: tours of up to 16, 32 and 64
+// stops run on fixed-width bit masks and fixed arrays. Anything larger falls back to
+// searchGeneric(), which uses heap-allocated containers throughout.
+namespace RouteSearch
+{
+    // Seats per car when neither the request nor the driver specifies one.
+    inline constexpr int kDefaultCapacity = 4;
+
+    struct TourProblem
+    {
+        int driver = 0;                          // global node index of the driver
+        int capacity = kDefaultCapacity;         // passengers the car can hold at once
+        std::vector<int> stops;                  // global node index of each stop
+        std::vector<int> riders;                 // per stop: passengers boarding (> 0) or leaving (< 0)
+        std::vector<std::vector<int>> pickupsOf; // per stop: local indices of the pickups of everyone leaving
+        std::vector<std::vector<int>> neighbors; // local successors of each stop, driver last (stops.size())
+    };
+
+    // [total time, path of global node indices starting at the driver], {-1, {}} if no tour exists
+    using TourResult = std::pair<int, std::vector<int>>;
+
+    namespace detail
+    {
+        template <int MaxStops>
+        using MaskFor = std::conditional_t<MaxStops <= 16, std::uint16_t,
+                        std::conditional_t<MaxStops <= 32, std::uint32_t, std::uint64_t>>;
+
+        template <typename Mask, int MaxStops>
+        constexpr std::array<Mask, MaxStops> makeBitTable()
+        {
+            std::array<Mask, MaxStops> bits{};
+            for (int i = 0; i < MaxStops; ++i) {
+                bits[i] = static_cast<Mask>(std::uint64_t{1} << i);
+            }
+            return bits;
+        }
+
+        // Settled (node, visited) states. Load is implied by the visited set, so the
+        // first time a pair is popped it carries the cheapest way of reaching it.
+        template <typename Mask, int MaxStops>
+        class SettledStates
+        {
+        public:
+            explicit SettledStates(int numStops)
+            {
+                if constexpr (MaxStops <= 16) {
+                    dense_.resize(static_cast<std::size_t>(MaxStops + 1) << numStops);
+                }
+            }
+
+            // Returns false if the state was already settled.
+            bool insert(int node, Mask visited)
+            {
+                if constexpr (MaxStops <= 16) {
+                    auto bit = dense_[(static_cast<std::size_t>(visited) * (MaxStops + 1)) + node];
+                    if (bit) return false;
+                    bit = true;
+                    return true;
+                } else if constexpr (MaxStops <= 32) {
+                    return sparse_.insert(static_cast<std::uint64_t>(visited) | (std::uint64_t{static_cast<std::uint8_t>(node)} << 32)).second;
+                } else {
+                    return sparse_.insert({visited, node}).second;
+                }
+            }
+
+        private:
+            struct KeyHash {
+                std::size_t operator()(const std::pair<Mask, int>& k) const noexcept {
+                    return std::hash<Mask>{}(k.first) ^ (std::hash<int>{}(k.second) * 0x9e3779b97f4a7c15ull);
+                }
+            };
+
+            std::vector<bool> dense_;
+            std::conditional_t<MaxStops <= 32,
+                               std::unordered_set<std::uint64_t>,
+                               std::unordered_set<std::pair<Mask, int>, KeyHash>> sparse_;
+        };
+    } // namespace detail
+
+    // Fixed-size kernel for tours of at most MaxStops stops (MaxStops <= 64).
+    template <int MaxStops, typename TimeFn>
+    TourResult searchFixed(const TourProblem& problem, TimeFn&& travelTime)
+    {
+        static_assert(MaxStops > 0 && MaxStops <= 64, "fixed kernels use at most 64-bit masks");
+        using Mask = detail::MaskFor<MaxStops>;
+        static constexpr auto kBit = detail::makeBitTable<Mask, MaxStops>();
+        constexpr int kDriver = MaxStops;
+
+        const int numStops = static_cast<int>(problem.stops.size());
+        const int capacity = problem.capacity;
+        if (numStops == 0) return {0, {problem.driver}};
+        if (numStops > MaxStops) return {-1, {}};
+
+        const Mask allStops = static_cast<Mask>(numStops == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << numStops) - 1);
+
+        // precedence table: stops that must already be visited before each stop
+        std::array<Mask, MaxStops> required{};
+        std::array<int, MaxStops> riders{};
+        for (int i = 0; i < numStops; ++i) {
+            riders[i] = problem.riders[i];
+            for (int pickup : problem.pickupsOf[i]) required[i] |= kBit[pickup];
+        }
+
+        std::array<Mask, MaxStops + 1> successors{};
+        for (int i = 0; i <= numStops; ++i) {
+            Mask& out = successors[i == numStops ? kDriver : i];
+            for (int nb : problem.neighbors[i]) out |= kBit[nb];
+        }
+
+        auto globalOf = [&](int local) { return local == kDriver ? problem.driver : problem.stops[local]; };
+
+        // travel times are fetched lazily; -1 marks an edge that has not been asked for yet
+        std::array<std::array<int, MaxStops + 1>, MaxStops + 1> times;
+        for (auto& row : times) row.fill(-1);
+        auto timeBetween = [&](int from, int to) {
+            int& t = times[from][to];
+            if (t < 0) t = travelTime(globalOf(from), globalOf(to));
+            return t;
+        };
+
+        struct State {
+            int time;
+            std::uint8_t node;
+            std::uint8_t length;
+            std::uint16_t load;
+            Mask visited;
+            std::array<std::uint8_t, MaxStops> path;
+        };
+        auto cmp = [](const State& a, const State& b) { return a.time > b.time; };
+        std::priority_queue<State, std::vector<State>, decltype(cmp)> q(cmp);
+        detail::SettledStates<Mask, MaxStops> settled(numStops);
+
+        q.push(State{0, static_cast<std::uint8_t>(kDriver), 0, 0, 0, {}});
+        while (!q.empty()) {
+            State cur = q.top();
+            q.pop();
+            if (!settled.insert(cur.node, cur.visited)) continue;
+
+            if (cur.visited == allStops) {
+                std::vector<int> path;
+                path.reserve(cur.length + 1);
+                path.push_back(problem.driver);
+                for (int i = 0; i < cur.length; ++i) path.push_back(problem.stops[cur.path[i]]);
+                return {cur.time, std::move(path)};
+            }
+
+            Mask candidates = successors[cur.node] & allStops & static_cast<Mask>(~cur.visited);
+            while (candidates) {
+                const int next = std::countr_zero(candidates);
+                candidates &= candidates - 1;
+                if ((cur.visited & required[next]) != required[next]) continue;
+                if (cur.load + riders[next] > capacity) continue;
+
+                State child = cur;
+                child.time += timeBetween(cur.node, next);
+                child.node = static_cast<std::uint8_t>(next);
+                child.visited |= kBit[next];
+                child.load = static_cast<std::uint16_t>(cur.load + riders[next]);
+                child.path[child.length++] = static_cast<std::uint8_t>(next);
+                q.push(child);
+            }
+        }
+        return {-1, {}};
+    }
+
+    // Fallback for tours too large for a 64-bit mask. Same search as searchFixed().
+    template <typename TimeFn>
+    TourResult searchGeneric(const TourProblem& problem, TimeFn&& travelTime)
+    {
+        const int numStops = static_cast<int>(problem.stops.size());
+        auto globalOf = [&](int local) { return local == numStops ? problem.driver : problem.stops[local]; };
+
+        // time, node, visited, path, passengers in car
+        using nodeType = std::tuple<int, int, std::vector<bool>, std::vector<int>, int>;
+        auto cmp = [](const nodeType& a, const nodeType& b) { return std::get<0>(a) > std::get<0>(b); };
+        std::priority_queue<nodeType, std::vector<nodeType>, decltype(cmp)> q(cmp);
+
+        struct StateHash {
+            std::size_t operator()(const std::pair<int, std::vector<bool>>& s) const noexcept {
+                return std::hash<int>{}(s.first) ^ (std::hash<std::vector<bool>>{}(s.second) << 1);
+            }
+        };
+        std::unordered_set<std::pair<int, std::vector<bool>>, StateHash> settled;
+
+        q.push({0, numStops, std::vector<bool>(numStops), std::vector<int>{problem.driver}, 0});
+        while (!q.empty()) {
+            auto [cTime, cNode, cVisited, cPath, cInCar] = q.top();
+            q.pop();
+            if (!settled.insert({cNode, cVisited}).second) continue;
+            if (static_cast<int>(cPath.size()) == numStops + 1) return {cTime, cPath};
+
+            for (int next : problem.neighbors[cNode]) {
+                if (cVisited[next]) continue;
+                if (cInCar + problem.riders[next] > problem.capacity) continue;
+                auto const& pickups = problem.pickupsOf[next];
+                if (std::any_of(pickups.begin(), pickups.end(), [&](int p) { return !cVisited[p]; })) continue;
+
+                auto newVisited = cVisited;
+                auto newPath = cPath;
+                newVisited[next] = true;
+                newPath.push_back(problem.stops[next]);
+                q.push({cTime + travelTime(globalOf(cNode), globalOf(next)), next, std::move(newVisited),
+                        std::move(newPath), cInCar + problem.riders[next]});
+            }
+        }
+        return {-1, {}};
+    }
+
+    // travelTime(fromNode, toNode) returns minutes between two global node indices.
+    template <typename TimeFn>
+    TourResult findTour(const TourProblem& problem, TimeFn&& travelTime)
+    {
+        const std::size_t numStops = problem.stops.size();
+        if (numStops <= 16) return searchFixed<16>(problem, travelTime);
+        if (numStops <= 32) return searchFixed<32>(problem, travelTime);
+        if (numStops <= 64) return searchFixed<64>(problem, travelTime);
+        return searchGeneric(problem, travelTime);
+    }
+} // namespace RouteSearch